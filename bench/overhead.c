@@ -0,0 +1,169 @@
+/*
+ * Measures the overhead unstdtest itself adds to a test suite: the cost of a
+ * passing and of a failing assertion, of dispatching test functions through
+ * SINGLE_TEST and GROUP_TEST, and how trace recording scales with threads.
+ *
+ * Every sample repeats the measured operation OPS times, so the reported
+ * median divided by OPS is the cost of one operation. Output of the measured
+ * assertions and tests goes to /dev/null, so printing is included in the cost
+ * but does not flood the benchmark log. The redirect itself is done in the
+ * first and the last sample only, so it does not reach the median.
+ */
+#include "unstdtest.h"
+
+#include <pthread.h>
+
+#define OPS 1000
+#define SAMPLES 50
+#define MAX_THREADS 8
+
+/* Descriptors of /dev/null and of the real standard output. */
+static int SINK = -1, REAL_STDOUT = -1;
+
+/* Operands the compiler cannot see through, so assertions are not folded. */
+static volatile int ZERO = 0, ONE = 1;
+
+static struct {
+  pthread_t threads[MAX_THREADS];
+  pthread_barrier_t start, end;
+  unsigned int count;
+  bool stop;
+} POOL;
+
+static void *pool_worker(void *arg) {
+  (void)arg;
+  for (;;) {
+    pthread_barrier_wait(&POOL.start);
+    if (POOL.stop) {
+      return NULL;
+    }
+    for (unsigned int i = 0; i < OPS / 2; ++i) {
+      unstdtest_trace("event", "bench", 'B');
+      unstdtest_trace("event", "bench", 'E');
+    }
+    pthread_barrier_wait(&POOL.end);
+  }
+}
+
+static void pool_start(unsigned int count) {
+  POOL.count = count;
+  POOL.stop = false;
+  pthread_barrier_init(&POOL.start, NULL, count + 1);
+  pthread_barrier_init(&POOL.end, NULL, count + 1);
+  for (unsigned int i = 0; i < count; ++i) {
+    pthread_create(&POOL.threads[i], NULL, pool_worker, NULL);
+  }
+}
+
+static void pool_stop(void) {
+  POOL.stop = true;
+  pthread_barrier_wait(&POOL.start);
+  for (unsigned int i = 0; i < POOL.count; ++i) {
+    pthread_join(POOL.threads[i], NULL);
+  }
+  pthread_barrier_destroy(&POOL.start);
+  pthread_barrier_destroy(&POOL.end);
+}
+
+/* Sends standard output to /dev/null until quiet_end is called. */
+static void quiet_begin(void) {
+  fflush(stdout);
+  dup2(SINK, STDOUT_FILENO);
+}
+
+static void quiet_end(void) {
+  fflush(stdout);
+  dup2(REAL_STDOUT, STDOUT_FILENO);
+}
+
+/* Silences a BENCHMARK from its first sample to its last, using the sample
+ * counter of the BENCHMARK macro, so its report is still printed. */
+#define QUIET_BEGIN()                                                          \
+  if (unstdtest_i == 0) {                                                      \
+    quiet_begin();                                                             \
+  }
+#define QUIET_END()                                                            \
+  if (unstdtest_i + 1 == unstdtest_count) {                                    \
+    quiet_end();                                                               \
+  }
+
+FUNCTION(empty_test, {})
+
+/* Passing assertions print nothing, as MAIN turns --verbose off for them. */
+BENCHMARK(bench_passing_assertions, SAMPLES, {
+  for (int i = 0; i < OPS; ++i) {
+    int same = i + ZERO;
+    ASSERT_EQ_INT("passing", i, same, false);
+  }
+})
+
+BENCHMARK(bench_failing_assertions, SAMPLES, {
+  unsigned int tests = TOTAL_TEST_COUNTER, failed = TOTAL_FAILED_COUNTER;
+  QUIET_BEGIN();
+  for (int i = 0; i < OPS; ++i) {
+    int other = i + ONE;
+    ASSERT_EQ_INT("failing", i, other, false);
+  }
+  QUIET_END();
+  /* The failures are the measured operation, not results of the suite. */
+  TOTAL_TEST_COUNTER = tests;
+  TOTAL_FAILED_COUNTER = failed;
+})
+
+BENCHMARK(bench_single_test_dispatch, SAMPLES, {
+  QUIET_BEGIN();
+  for (int i = 0; i < OPS; ++i) {
+    SINGLE_TEST(empty_test);
+  }
+  QUIET_END();
+})
+
+BENCHMARK(bench_group_test_dispatch, SAMPLES, {
+  QUIET_BEGIN();
+  for (int i = 0; i < OPS / 8; ++i) {
+    GROUP_TEST("group", empty_test, empty_test, empty_test, empty_test,
+               empty_test, empty_test, empty_test, empty_test);
+  }
+  QUIET_END();
+})
+
+#define BENCH_TRACE_THREADS(BENCHNAME)                                         \
+  BENCHMARK(BENCHNAME, SAMPLES, {                                              \
+    pthread_barrier_wait(&POOL.start);                                         \
+    pthread_barrier_wait(&POOL.end);                                           \
+  })
+
+BENCH_TRACE_THREADS(bench_trace_1_thread)
+BENCH_TRACE_THREADS(bench_trace_2_threads)
+BENCH_TRACE_THREADS(bench_trace_4_threads)
+BENCH_TRACE_THREADS(bench_trace_8_threads)
+
+MAIN({
+  SINK = open("/dev/null", O_WRONLY | O_CLOEXEC);
+  REAL_STDOUT = dup(STDOUT_FILENO);
+  if (SINK < 0 || REAL_STDOUT < 0) {
+    perror("/dev/null");
+    return T_EXIT_FAILED;
+  }
+  bool verbose = VERBOSE;
+  VERBOSE = false;
+  GROUP_TEST("assertions", bench_passing_assertions, bench_failing_assertions);
+  VERBOSE = verbose;
+  GROUP_TEST("dispatch", bench_single_test_dispatch, bench_group_test_dispatch);
+
+  /* Trace buffers are only released by a dump, so dump them to /dev/null. */
+  bool tracing = TRACE_ENABLED;
+  TRACE_PATH = TRACE_PATH != NULL ? TRACE_PATH : "/dev/null";
+  TRACE_ENABLED = true;
+  void (*scaling[])(void) = {bench_trace_1_thread, bench_trace_2_threads,
+                             bench_trace_4_threads, bench_trace_8_threads};
+  for (unsigned int i = 0, threads = 1; threads <= MAX_THREADS;
+       ++i, threads *= 2) {
+    pool_start(threads);
+    SINGLE_TEST(scaling[i]);
+    pool_stop();
+  }
+  TRACE_ENABLED = tracing;
+  close(SINK);
+  close(REAL_STDOUT);
+})
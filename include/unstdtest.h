@@ -1,8 +1,39 @@
 #pragma once
 
+/* Snapshots, benchmarks and the crash handlers use POSIX.1-2008 with the XSI
+ * extension, which strict -std=c11 builds hide unless asked for. GNU dialects
+ * already expose them. */
+#if defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE) &&                   \
+    !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE) &&                        \
+    !defined(_DEFAULT_SOURCE)
+#define _XOPEN_SOURCE 700
+#endif
+
 #include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#include <time.h>
+#include <unistd.h>
+
+#if !defined(O_CLOEXEC) || !defined(SA_RESETHAND)
+#error "unstdtest.h needs POSIX.1-2008 with XSI: include it before other       \
+headers or define _XOPEN_SOURCE to 700"
+#endif
 
 enum TTypes {
   T_BOOL,
@@ -15,6 +46,12 @@ enum TTypes {
   T_CHAR,
   T_UCHAR,
   T_FLOAT,
+  T_DOUBLE,
+  T_PTR,
+  T_SIZE,
+  T_STRING,
+  T_BUFFER,
+  T_STRUCT,
   UNKNOWN,
 };
 
@@ -22,6 +59,7 @@ enum TTypes {
   _Generic((x),                                                                \
       _Bool: T_BOOL,                                                           \
       float: T_FLOAT,                                                          \
+      double: T_DOUBLE,                                                        \
       char: T_CHAR,                                                            \
       int: T_INT,                                                              \
       short: T_SHORT,                                                          \
@@ -30,13 +68,458 @@ enum TTypes {
       unsigned short: T_USHORT,                                                \
       unsigned long: T_ULONG,                                                  \
       unsigned char: T_UCHAR,                                                  \
+      char *: T_STRING,                                                        \
+      const char *: T_STRING,                                                  \
       default: UNKNOWN)
 
 static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
                     TOTAL_IGNORED_COUNTER = 0, TOTAL_SUCCESSFUL_COUNTER = 0,
                     TOTAL_TEST_COUNTER_PER_FUNCTION = 0,
                     TOTAL_FAILED_COUNTER_PER_FUNCTION = 0,
-                    TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION = 0;
+                    TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION = 0,
+                    TOTAL_REGRESSION_COUNTER = 0;
+
+static unsigned int TOTAL_CANCELLED_COUNTER = 0;
+
+/* Test functions and benchmarks that were started. */
+static unsigned int TOTAL_FUNCTION_COUNTER = 0;
+
+/* Stop starting new tests once this many assertions failed, 0 for never. */
+static unsigned int MAX_FAILURES = 0;
+
+/* Seconds a single test may run before the process is stopped, 0 for never. */
+static unsigned int TEST_TIMEOUT = 0;
+
+/* Size of the alternate stack the crash handlers run on. */
+#ifndef SIGNAL_STACK_SIZE
+#define SIGNAL_STACK_SIZE 65536
+#endif
+
+/* Name of the running test, read by the crash and timeout handlers. */
+static const char *volatile CURRENT_TEST_NAME = NULL;
+
+/* Name of the async test whose body or callback is running, printed before
+ * its assertion lines as they interleave with those of other async tests. */
+static const char *CURRENT_ASYNC_NAME = NULL;
+
+/* Report passing assertions too, not only failures. */
+static bool VERBOSE = false;
+
+/**
+ * @brief Process exit statuses returned by MAIN.
+ */
+enum TExitCodes {
+  T_EXIT_OK = 0,
+  T_EXIT_FAILED = 1,
+  T_EXIT_CRASHED = 2,
+  T_EXIT_TIMEOUT = 3,
+  T_EXIT_NO_TESTS = 4,
+  T_EXIT_REGRESSION = 5,
+  T_EXIT_USAGE = 6,
+};
+
+static bool UPDATE_SNAPSHOTS = false;
+
+static const char *BENCH_SAVE_PATH = NULL, *BENCH_BASELINE_PATH = NULL;
+
+/* Minimum median slowdown, in percent, reported as a regression. */
+static double BENCH_THRESHOLD = 5.0;
+
+/* One-sided z critical value of the regression test, 2.326 is p < 0.01. */
+#ifndef BENCH_Z_CRITICAL
+#define BENCH_Z_CRITICAL 2.326
+#endif
+
+/* Number of events each thread keeps, older events are overwritten. */
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS 16384
+#endif
+
+/**
+ * @brief One begin or end event of the execution trace.
+ */
+struct TTraceEvent {
+  const char *name;
+  const char *category;
+  unsigned long long timestamp;
+  /* Pairs the begin and end of an async span, 0 for other events. */
+  uintptr_t id;
+  char phase;
+};
+
+/**
+ * @brief Ring buffer of trace events written by a single thread. Buffers are
+ * linked into TRACE_BUFFERS when created and live until the trace is dumped.
+ */
+struct TTraceBuffer {
+  struct TTraceBuffer *next;
+  unsigned int tid;
+  atomic_ullong head;
+  struct TTraceEvent events[TRACE_BUFFER_EVENTS];
+};
+
+static const char *TRACE_PATH = NULL;
+static atomic_bool TRACE_ENABLED = false;
+static struct TTraceBuffer *_Atomic TRACE_BUFFERS = NULL;
+static atomic_uint TRACE_THREADS = 0;
+static _Thread_local struct TTraceBuffer *TRACE_BUFFER = NULL;
+
+/**
+ * @brief How an assertion compares its operands, used to word its failure.
+ */
+enum TRelations {
+  T_REL_EQ,
+  T_REL_NEQ,
+  T_REL_GR,
+  T_REL_GTE,
+  T_REL_LE,
+  T_REL_LTE,
+  T_REL_TRUE,
+  T_REL_FALSE,
+};
+
+/**
+ * @brief An assertion operand captured for the failure message. Values are
+ * only captured once an assertion failed and are formatted by unstdtest_fail.
+ */
+struct TValue {
+  enum TTypes type;
+  union {
+    long long i;
+    unsigned long long u;
+    double f;
+    const void *p;
+  };
+  /* Length in bytes of T_BUFFER and T_STRUCT values. */
+  size_t size;
+  /* Type name of T_STRUCT values, used to find their printer. */
+  const char *type_name;
+};
+
+/**
+ * @brief Captures an operand of the given type into a struct TValue.
+ * @param TYPE_TAG One of TTypes.
+ * @param FIELD    Union member holding the value: i, u, f or p.
+ * @param x        The operand.
+ */
+#define T_VALUE(TYPE_TAG, FIELD, x)                                            \
+  ((struct TValue){.type = (TYPE_TAG), .FIELD = (x)})
+
+/**
+ * @brief Prints a value of a user type to the given stream.
+ */
+typedef void (*TPrinter)(FILE *file, const void *value);
+
+#ifndef MAX_PRINTERS
+#define MAX_PRINTERS 64
+#endif
+
+static struct {
+  const char *type_name;
+  TPrinter printer;
+} PRINTERS[MAX_PRINTERS];
+static size_t PRINTERS_COUNT = 0;
+
+/**
+ * @brief Registers the printer used for failed ASSERT_EQ_STRUCT assertions on
+ * the given type. Registering a type again replaces its printer.
+ * @param type_name Spelling of the type as passed to ASSERT_EQ_STRUCT.
+ * @param printer   Function printing a value of that type.
+ * @return false if there is no room left for another printer.
+ */
+static inline bool unstdtest_register_printer(const char *type_name,
+                                              TPrinter printer) {
+  for (size_t i = 0; i < PRINTERS_COUNT; ++i) {
+    if (strcmp(PRINTERS[i].type_name, type_name) == 0) {
+      PRINTERS[i].printer = printer;
+      return true;
+    }
+  }
+  if (PRINTERS_COUNT == MAX_PRINTERS) {
+    fprintf(stderr, "unstdtest: no room for the printer of '%s'.\n",
+            type_name);
+    return false;
+  }
+  PRINTERS[PRINTERS_COUNT].type_name = type_name;
+  PRINTERS[PRINTERS_COUNT++].printer = printer;
+  return true;
+}
+
+/**
+ * @brief Registers a printer for failure messages of a user type.
+ * @param TYPENAME The type, spelled exactly as in ASSERT_EQ_STRUCT.
+ * @param printer  A void (*)(FILE *, const void *) printing one value.
+ */
+#define REGISTER_PRINTER(TYPENAME, printer)                                    \
+  unstdtest_register_printer(#TYPENAME, printer)
+
+/**
+ * @brief Finds the offset of the first byte that differs between two buffers.
+ * Equal blocks are skipped with memcmp, so only the block holding the
+ * difference is scanned byte by byte.
+ * @param expected The first buffer.
+ * @param actual   The second buffer.
+ * @param len      Number of bytes to compare.
+ * @return Offset of the first differing byte, or len if both are equal.
+ */
+static inline size_t unstdtest_first_difference(const unsigned char *expected,
+                                                const unsigned char *actual,
+                                                size_t len) {
+  size_t offset = 0;
+  while (len - offset >= 4096 &&
+         memcmp(expected + offset, actual + offset, 4096) == 0) {
+    offset += 4096;
+  }
+  while (offset < len && expected[offset] == actual[offset]) {
+    offset++;
+  }
+  return offset;
+}
+
+/**
+ * @brief Prints up to 16 bytes of a buffer around the given offset as hex.
+ * @param label  Name printed in front of the bytes.
+ * @param data   The buffer to print from.
+ * @param len    Length of the buffer.
+ * @param offset Offset of the first differing byte.
+ */
+static inline void unstdtest_print_hex_window(const char *label,
+                                              const unsigned char *data,
+                                              size_t len, size_t offset) {
+  size_t start = offset & ~(size_t)7;
+  size_t end = start + 16 < len ? start + 16 : len;
+  fprintf(stdout, "\t  %-8s @0x%08zx:", label, start);
+  for (size_t i = start; i < end; ++i) {
+    fprintf(stdout, i == offset ? " [%02x]" : " %02x", data[i]);
+  }
+  fprintf(stdout, offset >= len ? " <eof>\n" : "\n");
+}
+
+/**
+ * @brief Prints a character escaped the way it would be written in C source.
+ */
+static inline void unstdtest_print_escaped(FILE *file, unsigned char c,
+                                           char quote) {
+  const char *escapes = "\a\b\f\n\r\t\v";
+  const char *names = "abfnrtv";
+  const char *escape = c != '\0' ? strchr(escapes, c) : NULL;
+  if (escape != NULL) {
+    fprintf(file, "\\%c", names[escape - escapes]);
+  } else if (c == (unsigned char)quote || c == '\\') {
+    fprintf(file, "\\%c", c);
+  } else if (c < 0x20 || c >= 0x7f) {
+    fprintf(file, "\\x%02x", c);
+  } else {
+    fputc(c, file);
+  }
+}
+
+/**
+ * @brief Prints bytes as hex, eliding everything after the first 16.
+ */
+static inline void unstdtest_print_bytes(FILE *file, const unsigned char *data,
+                                         size_t len) {
+  size_t shown = len < 16 ? len : 16;
+  fputc('{', file);
+  for (size_t i = 0; i < shown; ++i) {
+    fprintf(file, i ? " %02x" : "%02x", data[i]);
+  }
+  fprintf(file, "%s} (%zu bytes)", shown < len ? " ..." : "", len);
+}
+
+/**
+ * @brief Prints a captured operand in full precision: floats with enough
+ * digits to round-trip, strings and characters quoted and escaped, buffers as
+ * hex and user types through their registered printer.
+ */
+static inline void unstdtest_print_value(FILE *file,
+                                         const struct TValue *value) {
+  switch (value->type) {
+  case T_BOOL:
+    fputs(value->i ? "true" : "false", file);
+    break;
+  case T_CHAR:
+  case T_UCHAR:
+    fputc('\'', file);
+    unstdtest_print_escaped(file, (unsigned char)value->i, '\'');
+    fputc('\'', file);
+    break;
+  case T_UINT:
+  case T_USHORT:
+  case T_ULONG:
+    fprintf(file, "%llu", value->u);
+    break;
+  case T_SIZE:
+    fprintf(file, "%llu bytes", value->u);
+    break;
+  case T_FLOAT:
+    fprintf(file, "%.9g", value->f);
+    break;
+  case T_DOUBLE:
+    fprintf(file, "%.17g", value->f);
+    break;
+  case T_PTR:
+    if (value->p == NULL) {
+      fputs("NULL", file);
+    } else {
+      fprintf(file, "%p", value->p);
+    }
+    break;
+  case T_STRING: {
+    if (value->p == NULL) {
+      fputs("NULL", file);
+      break;
+    }
+    const unsigned char *string = value->p;
+    size_t len = strlen(value->p);
+    fputc('"', file);
+    for (size_t i = 0; i < len && i < 256; ++i) {
+      unstdtest_print_escaped(file, string[i], '"');
+    }
+    fprintf(file, len > 256 ? "\"... (%zu chars)" : "\"", len);
+    break;
+  }
+  case T_BUFFER:
+    unstdtest_print_bytes(file, value->p, value->size);
+    break;
+  case T_STRUCT:
+    for (size_t i = 0; i < PRINTERS_COUNT; ++i) {
+      if (strcmp(PRINTERS[i].type_name, value->type_name) == 0) {
+        PRINTERS[i].printer(file, value->p);
+        return;
+      }
+    }
+    fprintf(file, "%s ", value->type_name);
+    unstdtest_print_bytes(file, value->p, value->size);
+    break;
+  default:
+    fprintf(file, "%lld", value->i);
+    break;
+  }
+}
+
+/**
+ * @brief Starts the line of an assertion result with its mark, followed by the
+ * name of the async test that made it, if any.
+ * @param mark '+' for a passed assertion or '-' for a failed one.
+ */
+static __attribute__((noinline, unused)) void unstdtest_print_mark(char mark) {
+  if (CURRENT_ASYNC_NAME != NULL) {
+    fprintf(stdout, "%c \t[%s] ", mark, CURRENT_ASYNC_NAME);
+  } else {
+    fprintf(stdout, "%c \t", mark);
+  }
+}
+
+/**
+ * @brief Prints the line of a passed assertion, only done with --verbose. The
+ * line is flushed so that it is not lost if the test crashes.
+ * @param desc A human-readable description explaining the test.
+ * @param file Source file of the assertion.
+ * @param line Source line of the assertion.
+ */
+static __attribute__((noinline, unused)) void
+unstdtest_print_pass(const char *desc, const char *file, int line) {
+  unstdtest_print_mark('+');
+  fprintf(stdout, "\"%s\" %s:%d Ok.\n", desc, file, line);
+  fflush(stdout);
+}
+
+/**
+ * @brief Counts a passed assertion. Nothing is formatted unless --verbose was
+ * given.
+ * @param desc A human-readable description explaining the test.
+ * @param file Source file of the assertion.
+ * @param line Source line of the assertion.
+ */
+static inline void unstdtest_pass(const char *desc, const char *file,
+                                  int line) {
+  TOTAL_TEST_COUNTER++;
+  TOTAL_TEST_COUNTER_PER_FUNCTION++;
+  TOTAL_SUCCESSFUL_COUNTER++;
+  TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;
+  if (VERBOSE) {
+    unstdtest_print_pass(desc, file, line);
+  }
+}
+
+/**
+ * @brief Counts a failed assertion and starts its error line. The caller
+ * prints the rest of the message and then calls unstdtest_fail_end.
+ * @param desc A human-readable description explaining the test.
+ * @param file Source file of the assertion.
+ * @param line Source line of the assertion.
+ */
+static __attribute__((cold, unused)) void
+unstdtest_fail_begin(const char *desc, const char *file, int line) {
+  TOTAL_TEST_COUNTER++;
+  TOTAL_TEST_COUNTER_PER_FUNCTION++;
+  TOTAL_FAILED_COUNTER++;
+  TOTAL_FAILED_COUNTER_PER_FUNCTION++;
+  unstdtest_print_mark('-');
+  fprintf(stdout, "\"%s\" %s:%d Error: ", desc, file, line);
+}
+
+/**
+ * @brief Finishes the report of a failed assertion and flushes it, so that it
+ * is not lost if the test crashes later. A failed required assertion stops the
+ * process with T_EXIT_FAILED.
+ * @param required Indicates whether the test is required to pass.
+ */
+static __attribute__((cold, unused)) void unstdtest_fail_end(bool required) {
+  if (required) {
+    fputs("This test is required and must pass to continue.\n", stdout);
+  }
+  fflush(stdout);
+  if (required) {
+    exit(T_EXIT_FAILED);
+  }
+}
+
+/**
+ * @brief Counts a failed assertion and formats its message. All formatting of
+ * assertion operands happens here, off the path of passing assertions.
+ * @param desc     A human-readable description explaining the test.
+ * @param file     Source file of the assertion.
+ * @param line     Source line of the assertion.
+ * @param relation How expected and actual were compared.
+ * @param expected The value expected to be received.
+ * @param actual   The value that was received.
+ * @param required Indicates whether the test is required to pass.
+ */
+static __attribute__((cold, noinline, unused)) void
+unstdtest_fail(const char *desc, const char *file, int line,
+               enum TRelations relation, struct TValue expected,
+               struct TValue actual, bool required) {
+  static const char *const wording[][3] = {
+      [T_REL_EQ] = {"expected: ", ", got: ", "."},
+      [T_REL_NEQ] = {"", " not expected to be equal to ", "."},
+      [T_REL_GR] = {"expected ", " to be greater than ", "."},
+      [T_REL_GTE] = {"expected ", " to be greater than or equal to ", "."},
+      [T_REL_LE] = {"expected ", " to be less than ", "."},
+      [T_REL_LTE] = {"expected ", " to be less than or equal to ", "."},
+  };
+  unstdtest_fail_begin(desc, file, line);
+  if (relation == T_REL_TRUE || relation == T_REL_FALSE) {
+    fprintf(stdout, "expected actual value to be %s, but got %s.\n",
+            relation == T_REL_TRUE ? "true" : "false",
+            relation == T_REL_TRUE ? "false" : "true");
+  } else {
+    fputs(wording[relation][0], stdout);
+    unstdtest_print_value(stdout, &expected);
+    fputs(wording[relation][1], stdout);
+    unstdtest_print_value(stdout, &actual);
+    fprintf(stdout, "%s\n", wording[relation][2]);
+  }
+  if (relation == T_REL_EQ &&
+      (actual.type == T_BUFFER || actual.type == T_STRUCT)) {
+    size_t common = expected.size < actual.size ? expected.size : actual.size;
+    size_t offset = unstdtest_first_difference(expected.p, actual.p, common);
+    unstdtest_print_hex_window("expected", expected.p, expected.size, offset);
+    unstdtest_print_hex_window("got", actual.p, actual.size, offset);
+  }
+  unstdtest_fail_end(required);
+}
 
 /**
  * @brief Checks if the actual integer is equal to the expected integer value.
@@ -50,20 +533,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_INT && TYPE(actual) == T_INT),         \
                    "Both expected and actual must be of type int");            \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected != actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout, "- \t\"%s\" %s:%d Error: expected: %d, got: %d.\n%s",    \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     T_VALUE(T_INT, i, expected), T_VALUE(T_INT, i, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -80,22 +555,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_INT && TYPE(actual) == T_INT),         \
                    "Both expected and actual must be of type int");            \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected > actual) {                                                   \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: expected %d to be greater than %d.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, expected, actual,                      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_GR,                   \
+                     T_VALUE(T_INT, i, expected), T_VALUE(T_INT, i, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -112,22 +577,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_INT && TYPE(actual) == T_INT),         \
                    "Both expected and actual must be of type int");            \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (!(expected <= actual)) {                                               \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected %d to be greater than or "     \
-              "equal %d.\n%s",                                                 \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_GTE,                  \
+                     T_VALUE(T_INT, i, expected), T_VALUE(T_INT, i, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -143,21 +598,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_INT && TYPE(actual) == T_INT),         \
                    "Both expected and actual must be of type int");            \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected < actual || expected == actual) {                             \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected %d to be less than %d.\n%s",   \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LE,                   \
+                     T_VALUE(T_INT, i, expected), T_VALUE(T_INT, i, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -174,22 +620,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_INT && TYPE(actual) == T_INT),         \
                    "Both expected and actual must be of type int");            \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (!(expected >= actual)) {                                               \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected %d to be less than or equal "  \
-              "%d.\n%s",                                                       \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LTE,                  \
+                     T_VALUE(T_INT, i, expected), T_VALUE(T_INT, i, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -206,22 +642,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_INT && TYPE(actual) == T_INT),         \
                    "Both expected and actual must be of type int");            \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected == actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: %d not expected to be equal to %d.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, expected, actual,                      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_NEQ,                  \
+                     T_VALUE(T_INT, i, expected), T_VALUE(T_INT, i, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -237,20 +663,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_FLOAT && TYPE(actual) == T_FLOAT),     \
                    "Both expected and actual must be of type float");          \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected != actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout, "- \t\"%s\" %s:%d Error: expected %f, got: %f.\n%s",     \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     T_VALUE(T_FLOAT, f, expected),                            \
+                     T_VALUE(T_FLOAT, f, actual), required);                   \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -266,20 +684,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_FLOAT && TYPE(actual) == T_FLOAT),     \
                    "Both expected and actual must be of type float");          \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected == actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout, "- \t\"%s\" %s:%d Error: expected: %f, got: %f.\n%s",    \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_NEQ,                  \
+                     T_VALUE(T_FLOAT, f, expected),                            \
+                     T_VALUE(T_FLOAT, f, actual), required);                   \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -295,22 +705,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_FLOAT && TYPE(actual) == T_FLOAT),     \
                    "Both expected and actual must be of type float");          \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected > actual) {                                                   \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: expected %f to be greater than %f.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, expected, actual,                      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_GR,                   \
+                     T_VALUE(T_FLOAT, f, expected),                            \
+                     T_VALUE(T_FLOAT, f, actual), required);                   \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -326,21 +726,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_FLOAT && TYPE(actual) == T_FLOAT),     \
                    "Both expected and actual must be of type float");          \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected < actual) {                                                   \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected %f to be less than %f.\n%s",   \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LE,                   \
+                     T_VALUE(T_FLOAT, f, expected),                            \
+                     T_VALUE(T_FLOAT, f, actual), required);                   \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -356,20 +747,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_CHAR && TYPE(actual) == T_CHAR),       \
                    "Both expected and actual must be of type char");           \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected != actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout, "- \t\"%s\" %s:%d Error: expected '%c', got: '%c'.\n%s", \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     T_VALUE(T_CHAR, i, expected), T_VALUE(T_CHAR, i, actual), \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -385,20 +768,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_CHAR && TYPE(actual) == T_CHAR),       \
                    "Both expected and actual must be of type char");           \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected == actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout, "- \t\"%s\" %s:%d Error: expected '%c', got: '%c'.\n%s", \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_NEQ,                  \
+                     T_VALUE(T_CHAR, i, expected), T_VALUE(T_CHAR, i, actual), \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -414,22 +789,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_CHAR && TYPE(actual) == T_CHAR),       \
                    "Both expected and actual must be of type char");           \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected > actual) {                                                   \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected '%c' to be greater than "      \
-              "'%c'.\n%s",                                                     \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_GR,                   \
+                     T_VALUE(T_CHAR, i, expected), T_VALUE(T_CHAR, i, actual), \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -446,22 +811,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_CHAR && TYPE(actual) == T_CHAR),       \
                    "Both expected and actual must be of type char");           \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (!(expected <= actual)) {                                               \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected '%c' to be greater than or "   \
-              "equal '%c'.\n%s",                                               \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_GTE,                  \
+                     T_VALUE(T_CHAR, i, expected), T_VALUE(T_CHAR, i, actual), \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -477,23 +832,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_CHAR && TYPE(actual) == T_CHAR),       \
                    "Both expected and actual must be of type char");           \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
-    if (expected < actual || expected == actual)) {                            \
-        TOTAL_FAILED_COUNTER++;                                                \
-        TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                   \
-        fprintf(                                                               \
-            stdout,                                                            \
-            "- \t\"%s\" %s:%d Error: expected '%c' to be less than '%c'.\n%s", \
-            TESTDESC, __FILE__, __LINE__, expected, actual,                    \
-            required ? "This test is required and must pass to continue.\n"    \
-                     : "");                                                    \
-        assert(required == false);                                             \
-      }                                                                        \
-    else {                                                                     \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+    if (expected < actual || expected == actual) {                             \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LE,                   \
+                     T_VALUE(T_CHAR, i, expected), T_VALUE(T_CHAR, i, actual), \
+                     required);                                                \
+    } else {                                                                   \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -509,22 +853,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
   do {                                                                         \
     _Static_assert((TYPE(expected) == T_CHAR && TYPE(actual) == T_CHAR),       \
                    "Both expected and actual must be of type char");           \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (!(expected >= actual)) {                                               \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected '%c' to be less than or "      \
-              "equal '%c'.\n%s",                                               \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LTE,                  \
+                     T_VALUE(T_CHAR, i, expected), T_VALUE(T_CHAR, i, actual), \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -538,20 +872,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  */
 #define ASSERT_EQ_PTR(TESTDESC, expected, actual, required)                    \
   do {                                                                         \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected != actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout, "- \t\"%s\" %s:%d Error: expected: %p, got: %p.\n%s",    \
-              TESTDESC, __FILE__, __LINE__, expected, actual,                  \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     T_VALUE(T_PTR, p, expected), T_VALUE(T_PTR, p, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -565,22 +891,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  */
 #define ASSERT_NEQ_PTR(TESTDESC, expected, actual, required)                   \
   do {                                                                         \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (expected == actual) {                                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: %p not expected to be equal to %p.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, expected, actual,                      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_NEQ,                  \
+                     T_VALUE(T_PTR, p, expected), T_VALUE(T_PTR, p, actual),   \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -595,22 +911,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
 #define ASSERT_TRUE(TESTDESC, actual, required)                                \
   do {                                                                         \
     _Static_assert((TYPE(actual) == T_BOOL), "Actual must be of type char");   \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (!actual) {                                                             \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected actual value to be true, but " \
-              "got false.\n%s",                                                \
-              TESTDESC, __FILE__, __LINE__,                                    \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_TRUE,                 \
+                     T_VALUE(T_BOOL, i, true), T_VALUE(T_BOOL, i, actual),     \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -625,22 +931,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
 #define ASSERT_FALSE(TESTDESC, actual, required)                               \
   do {                                                                         \
     _Static_assert((TYPE(actual) == T_BOOL), "Actual must be of type char");   \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (actual) {                                                              \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(stdout,                                                          \
-              "- \t\"%s\" %s:%d Error: expected actual value to be false, "    \
-              "but got true.\n%s",                                             \
-              TESTDESC, __FILE__, __LINE__,                                    \
-              required ? "This test is required and must pass to continue.\n"  \
-                       : "");                                                  \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_FALSE,                \
+                     T_VALUE(T_BOOL, i, false), T_VALUE(T_BOOL, i, actual),    \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -654,22 +950,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  */
 #define ASSERT_EQ_SIZE(TESTDESC, expected, actual, required)                   \
   do {                                                                         \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (sizeof(expected) != sizeof(actual)) {                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: expected size: %ld, got size: %ld.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, sizeof(expected), sizeof(actual),      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     T_VALUE(T_SIZE, u, sizeof(expected)),                     \
+                     T_VALUE(T_SIZE, u, sizeof(actual)), required);            \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -683,22 +969,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  */
 #define ASSERT_NEQ_SIZE(TESTDESC, expected, actual, required)                  \
   do {                                                                         \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (sizeof(expected) == sizeof(actual)) {                                  \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: expected size: %ld, got size: %ld.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, sizeof(expected), sizeof(actual),      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_NEQ,                  \
+                     T_VALUE(T_SIZE, u, sizeof(expected)),                     \
+                     T_VALUE(T_SIZE, u, sizeof(actual)), required);            \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -712,22 +988,12 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  */
 #define ASSERT_GR_SIZE(TESTDESC, expected, actual, required)                   \
   do {                                                                         \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (sizeof(expected) > sizeof(actual)) {                                   \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: expected size: %ld, got size: %ld.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, sizeof(expected), sizeof(actual),      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_GR,                   \
+                     T_VALUE(T_SIZE, u, sizeof(expected)),                     \
+                     T_VALUE(T_SIZE, u, sizeof(actual)), required);            \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
@@ -741,32 +1007,1384 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  */
 #define ASSERT_LE_SIZE(TESTDESC, expected, actual, required)                   \
   do {                                                                         \
-    TOTAL_TEST_COUNTER++;                                                      \
-    TOTAL_TEST_COUNTER_PER_FUNCTION++;                                         \
     if (sizeof(expected) < sizeof(actual)) {                                   \
-      TOTAL_FAILED_COUNTER++;                                                  \
-      TOTAL_FAILED_COUNTER_PER_FUNCTION++;                                     \
-      fprintf(                                                                 \
-          stdout,                                                              \
-          "- \t\"%s\" %s:%d Error: expected size: %ld, got size: %ld.\n%s",    \
-          TESTDESC, __FILE__, __LINE__, sizeof(expected), sizeof(actual),      \
-          required ? "This test is required and must pass to continue.\n"      \
-                   : "");                                                      \
-      assert(required == false);                                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LE,                   \
+                     T_VALUE(T_SIZE, u, sizeof(expected)),                     \
+                     T_VALUE(T_SIZE, u, sizeof(actual)), required);            \
+    } else {                                                                   \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Compares two strings, treating two NULL strings as equal.
+ */
+static inline bool unstdtest_str_equal(const char *a, const char *b) {
+  return a == NULL || b == NULL ? a == b : strcmp(a, b) == 0;
+}
+
+/**
+ * @brief Checks if the actual string is equal to the expected string.
+ * @param TESTDESC A human-readable description explaining the test.
+ * @param expected The value expected to be received.
+ * @param actual   The value that was received.
+ * @param required Indicates whether the test process should panic if the test
+ * fails.
+ */
+#define ASSERT_EQ_STR(TESTDESC, expected, actual, required)                    \
+  do {                                                                         \
+    _Static_assert((TYPE(expected) == T_STRING && TYPE(actual) == T_STRING),   \
+                   "Both expected and actual must be strings");                \
+    if (!unstdtest_str_equal(expected, actual)) {                              \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     T_VALUE(T_STRING, p, expected),                           \
+                     T_VALUE(T_STRING, p, actual), required);                  \
+    } else {                                                                   \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Checks if the actual string is not equal to the expected string.
+ * @param TESTDESC A human-readable description explaining the test.
+ * @param expected The value expected to be received.
+ * @param actual   The value that was received.
+ * @param required Indicates whether the test process should panic if the test
+ * fails.
+ */
+#define ASSERT_NEQ_STR(TESTDESC, expected, actual, required)                   \
+  do {                                                                         \
+    _Static_assert((TYPE(expected) == T_STRING && TYPE(actual) == T_STRING),   \
+                   "Both expected and actual must be strings");                \
+    if (unstdtest_str_equal(expected, actual)) {                               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_NEQ,                  \
+                     T_VALUE(T_STRING, p, expected),                           \
+                     T_VALUE(T_STRING, p, actual), required);                  \
+    } else {                                                                   \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Checks if the first len bytes of two buffers are equal.
+ * @param TESTDESC A human-readable description explaining the test.
+ * @param expected Pointer to the bytes expected to be received.
+ * @param actual   Pointer to the bytes that were received.
+ * @param len      Number of bytes to compare.
+ * @param required Indicates whether the test process should panic if the test
+ * fails.
+ */
+#define ASSERT_EQ_MEM(TESTDESC, expected, actual, len, required)               \
+  do {                                                                         \
+    if (memcmp(expected, actual, len) != 0) {                                  \
+      unstdtest_fail(                                                          \
+          TESTDESC, __FILE__, __LINE__, T_REL_EQ,                              \
+          (struct TValue){.type = T_BUFFER, .p = (expected), .size = (len)},   \
+          (struct TValue){.type = T_BUFFER, .p = (actual), .size = (len)},     \
+          required);                                                           \
+    } else {                                                                   \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Checks if two values of a user type are bytewise equal. On failure
+ * both are printed with the printer registered through REGISTER_PRINTER, or as
+ * hex without one. Padding is compared too, so initialize values with memset
+ * or {0} before filling them in.
+ * @param TESTDESC A human-readable description explaining the test.
+ * @param TYPENAME The type of both values, such as struct point.
+ * @param expected The value expected to be received.
+ * @param actual   The value that was received.
+ * @param required Indicates whether the test process should panic if the test
+ * fails.
+ */
+#define ASSERT_EQ_STRUCT(TESTDESC, TYPENAME, expected, actual, required)       \
+  do {                                                                         \
+    _Static_assert(_Generic((expected), TYPENAME: 1, default: 0) &&            \
+                       _Generic((actual), TYPENAME: 1, default: 0),            \
+                   "Both expected and actual must be of type " #TYPENAME);     \
+    if (memcmp(&(expected), &(actual), sizeof(TYPENAME)) != 0) {               \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_EQ,                   \
+                     (struct TValue){.type = T_STRUCT,                         \
+                                     .p = &(expected),                         \
+                                     .size = sizeof(TYPENAME),                 \
+                                     .type_name = #TYPENAME},                  \
+                     (struct TValue){.type = T_STRUCT,                         \
+                                     .p = &(actual),                           \
+                                     .size = sizeof(TYPENAME),                 \
+                                     .type_name = #TYPENAME},                  \
+                     required);                                                \
     } else {                                                                   \
-      TOTAL_SUCCESSFUL_COUNTER++;                                              \
-      TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION++;                                 \
-      fprintf(stdout, "+ \t\"%s\" %s:%d Ok.\n", TESTDESC, __FILE__, __LINE__); \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
     }                                                                          \
   } while (0)
 
+/**
+ * @brief Replaces a file with the given contents atomically. The data is
+ * written to a temporary file next to the target, synced and then renamed over
+ * it, so readers never observe a partially written file.
+ * @param path Path of the file to replace.
+ * @param data Contents to write.
+ * @param len  Number of bytes to write.
+ * @return true on success, false otherwise.
+ */
+static inline bool unstdtest_write_file_atomic(const char *path,
+                                               const void *data, size_t len) {
+  char tmppath[strlen(path) + sizeof(".XXXXXX")];
+  snprintf(tmppath, sizeof(tmppath), "%s.XXXXXX", path);
+  int fd = mkstemp(tmppath);
+  if (fd < 0) {
+    return false;
+  }
+  const unsigned char *cursor = data;
+  size_t left = len;
+  while (left > 0) {
+    ssize_t written = write(fd, cursor, left);
+    if (written < 0) {
+      close(fd);
+      unlink(tmppath);
+      return false;
+    }
+    cursor += written;
+    left -= (size_t)written;
+  }
+  if (fchmod(fd, 0644) != 0 || fsync(fd) != 0) {
+    close(fd);
+    unlink(tmppath);
+    return false;
+  }
+  close(fd);
+  if (rename(tmppath, path) != 0) {
+    unlink(tmppath);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Compares a buffer against a golden file and counts the result. The
+ * golden file is mapped into memory and compared in place, and on mismatch the
+ * first differing region of both sides is printed. When UPDATE_SNAPSHOTS is
+ * set, missing or outdated golden files are rewritten instead.
+ * @param desc     A human-readable description explaining the test.
+ * @param file     Source file of the assertion.
+ * @param line     Source line of the assertion.
+ * @param actual   The buffer that was produced.
+ * @param len      Length of the produced buffer.
+ * @param path     Path of the golden file.
+ * @param required Indicates whether the test is required to pass.
+ * @return true if the buffer matches (or the snapshot was updated).
+ */
+static inline bool unstdtest_check_snapshot(const char *desc, const char *file,
+                                            int line, const void *actual,
+                                            size_t len, const char *path,
+                                            bool required) {
+  const unsigned char *expected = NULL;
+  size_t expected_len = 0;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd >= 0 && fstat(fd, &st) == 0) {
+    expected_len = (size_t)st.st_size;
+    if (expected_len > 0) {
+      void *map = mmap(NULL, expected_len, PROT_READ, MAP_PRIVATE, fd, 0);
+      expected = map == MAP_FAILED ? NULL : map;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (fd >= 0 && expected_len > 0 && expected == NULL) {
+    unstdtest_fail_begin(desc, file, line);
+    fprintf(stdout, "could not map snapshot %s.\n", path);
+    unstdtest_fail_end(required);
+    return false;
+  }
+
+  bool matches = fd >= 0 && expected_len == len &&
+                 (len == 0 || memcmp(expected, actual, len) == 0);
+  bool passed = matches;
+  if (matches) {
+    unstdtest_pass(desc, file, line);
+  } else if (UPDATE_SNAPSHOTS) {
+    passed = unstdtest_write_file_atomic(path, actual, len);
+    if (passed) {
+      unstdtest_pass(desc, file, line);
+      unstdtest_print_mark('+');
+      fprintf(stdout, "\"%s\" %s:%d Snapshot %s updated.\n", desc, file, line,
+              path);
+    } else {
+      unstdtest_fail_begin(desc, file, line);
+      fprintf(stdout, "could not update snapshot %s.\n", path);
+      unstdtest_fail_end(required);
+    }
+  } else if (fd < 0) {
+    unstdtest_fail_begin(desc, file, line);
+    fprintf(stdout,
+            "snapshot %s does not exist, run with --update-snapshots to "
+            "create it.\n",
+            path);
+    unstdtest_fail_end(required);
+  } else {
+    size_t common = expected_len < len ? expected_len : len;
+    size_t offset = unstdtest_first_difference(expected, actual, common);
+    unstdtest_fail_begin(desc, file, line);
+    fprintf(stdout,
+            "output differs from snapshot %s at offset %zu (expected %zu "
+            "bytes, got %zu bytes).\n",
+            path, offset, expected_len, len);
+    unstdtest_print_hex_window("expected", expected, expected_len, offset);
+    unstdtest_print_hex_window("got", actual, len, offset);
+    unstdtest_fail_end(required);
+  }
+
+  if (expected != NULL) {
+    munmap((void *)expected, expected_len);
+  }
+  return passed;
+}
+
+/**
+ * @brief Checks if the actual buffer matches the contents of a golden file.
+ * Run the test binary with --update-snapshots to create or rewrite golden
+ * files from the actual output.
+ * @param TESTDESC A human-readable description explaining the test.
+ * @param buf      Pointer to the bytes that were produced.
+ * @param len      Number of bytes that were produced.
+ * @param path     Path of the golden file.
+ * @param required Indicates whether the test process should panic if the test
+ * fails.
+ */
+#define ASSERT_MATCHES_SNAPSHOT(TESTDESC, buf, len, path, required)            \
+  do {                                                                         \
+    unstdtest_check_snapshot(TESTDESC, __FILE__, __LINE__, buf, len, path,     \
+                             required);                                        \
+  } while (0)
+
+/**
+ * @brief A named set of timing samples, either measured by a BENCHMARK in this
+ * run or loaded from a baseline file.
+ */
+struct TBenchRecord {
+  char *name;
+  unsigned long long *samples;
+  unsigned int count;
+};
+
+static struct TBenchRecord *BENCH_RESULTS = NULL, *BENCH_BASELINE = NULL;
+static size_t BENCH_RESULTS_COUNT = 0, BENCH_BASELINE_COUNT = 0;
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+static inline unsigned long long unstdtest_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ull +
+         (unsigned long long)ts.tv_nsec;
+}
+
+static inline int unstdtest_compare_ull(const void *a, const void *b) {
+  unsigned long long x = *(const unsigned long long *)a;
+  unsigned long long y = *(const unsigned long long *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Returns the median of a sorted array of samples.
+ */
+static inline double unstdtest_median(const unsigned long long *sorted,
+                                      unsigned int count) {
+  if (count == 0) {
+    return 0.0;
+  }
+  return count % 2 ? (double)sorted[count / 2]
+                   : ((double)sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+}
+
+/**
+ * @brief One-sided Mann-Whitney U test telling whether the current samples are
+ * significantly larger than the baseline samples. Uses the normal
+ * approximation with tie correction, so both sides should have at least ~20
+ * samples for the result to be meaningful.
+ * @param baseline Sorted baseline samples.
+ * @param nb       Number of baseline samples.
+ * @param current  Sorted current samples.
+ * @param nc       Number of current samples.
+ * @return true if current is slower with significance BENCH_Z_CRITICAL.
+ */
+static inline bool unstdtest_significantly_slower(
+    const unsigned long long *baseline, unsigned int nb,
+    const unsigned long long *current, unsigned int nc) {
+  if (nb < 2 || nc < 2) {
+    return false;
+  }
+  double n = (double)nb + nc;
+  double rank_sum = 0.0, tie_term = 0.0;
+  unsigned int i = 0, j = 0;
+  /* Both inputs are sorted, so ranks come from merging them. */
+  while (i < nb || j < nc) {
+    unsigned long long value =
+        j >= nc || (i < nb && baseline[i] < current[j]) ? baseline[i]
+                                                        : current[j];
+    unsigned int ties_b = 0, ties_c = 0;
+    while (i < nb && baseline[i] == value) {
+      i++;
+      ties_b++;
+    }
+    while (j < nc && current[j] == value) {
+      j++;
+      ties_c++;
+    }
+    double ties = (double)ties_b + ties_c;
+    double last_rank = (double)i + j;
+    rank_sum += ties_c * (last_rank - (ties - 1.0) / 2.0);
+    tie_term += ties * ties * ties - ties;
+  }
+  double u = rank_sum - nc * (nc + 1.0) / 2.0;
+  double mean = (double)nb * nc / 2.0;
+  double variance =
+      (double)nb * nc / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+  double distance = u - mean - 0.5;
+  return variance > 0.0 && distance > 0.0 &&
+         distance * distance >
+             BENCH_Z_CRITICAL * BENCH_Z_CRITICAL * variance;
+}
+
+/**
+ * @brief Releases an array of benchmark records and everything they own.
+ */
+static inline void unstdtest_bench_free(struct TBenchRecord *records,
+                                        size_t count) {
+  for (size_t r = 0; r < count; ++r) {
+    free(records[r].name);
+    free(records[r].samples);
+  }
+  free(records);
+}
+
+/**
+ * @brief Loads a baseline written by unstdtest_bench_save.
+ * @param path Path of the baseline file.
+ * @return true if the file was read successfully.
+ */
+static inline bool unstdtest_bench_load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  char magic[8];
+  uint32_t count = 0;
+  bool ok = fread(magic, sizeof(magic), 1, file) == 1 &&
+            memcmp(magic, "UNSTDBN1", sizeof(magic)) == 0 &&
+            fread(&count, sizeof(count), 1, file) == 1;
+  if (ok) {
+    BENCH_BASELINE = calloc(count, sizeof(*BENCH_BASELINE));
+    ok = BENCH_BASELINE != NULL || count == 0;
+  }
+  for (uint32_t r = 0; ok && r < count; ++r) {
+    struct TBenchRecord *record = &BENCH_BASELINE[r];
+    uint32_t name_len = 0, samples = 0;
+    ok = fread(&name_len, sizeof(name_len), 1, file) == 1 &&
+         name_len < 4096 && (record->name = calloc(name_len + 1, 1)) != NULL &&
+         fread(record->name, 1, name_len, file) == name_len &&
+         fread(&samples, sizeof(samples), 1, file) == 1 &&
+         (record->samples = malloc(samples * sizeof(uint64_t) + 1)) != NULL &&
+         fread(record->samples, sizeof(uint64_t), samples, file) == samples;
+    record->count = samples;
+    BENCH_BASELINE_COUNT = r + 1;
+  }
+  fclose(file);
+  if (!ok) {
+    unstdtest_bench_free(BENCH_BASELINE, BENCH_BASELINE_COUNT);
+    BENCH_BASELINE = NULL;
+    BENCH_BASELINE_COUNT = 0;
+  }
+  return ok;
+}
+
+/**
+ * @brief Writes every sample measured in this run to a baseline file. The
+ * format is the magic "UNSTDBN1", a uint32 record count and, per record, a
+ * uint32 name length, the name, a uint32 sample count and the uint64 samples
+ * in nanoseconds, all in native byte order.
+ * @param path Path of the baseline file, replaced atomically.
+ * @return true on success.
+ */
+static inline bool unstdtest_bench_save(const char *path) {
+  size_t size = 8 + sizeof(uint32_t);
+  for (size_t r = 0; r < BENCH_RESULTS_COUNT; ++r) {
+    size += 2 * sizeof(uint32_t) + strlen(BENCH_RESULTS[r].name) +
+            BENCH_RESULTS[r].count * sizeof(uint64_t);
+  }
+  unsigned char *buffer = malloc(size);
+  if (buffer == NULL) {
+    return false;
+  }
+  unsigned char *cursor = buffer;
+  uint32_t count = (uint32_t)BENCH_RESULTS_COUNT;
+  memcpy(cursor, "UNSTDBN1", 8);
+  memcpy(cursor + 8, &count, sizeof(count));
+  cursor += 8 + sizeof(count);
+  for (size_t r = 0; r < BENCH_RESULTS_COUNT; ++r) {
+    uint32_t name_len = (uint32_t)strlen(BENCH_RESULTS[r].name);
+    uint32_t samples = BENCH_RESULTS[r].count;
+    memcpy(cursor, &name_len, sizeof(name_len));
+    memcpy(cursor + sizeof(name_len), BENCH_RESULTS[r].name, name_len);
+    cursor += sizeof(name_len) + name_len;
+    memcpy(cursor, &samples, sizeof(samples));
+    memcpy(cursor + sizeof(samples), BENCH_RESULTS[r].samples,
+           samples * sizeof(uint64_t));
+    cursor += sizeof(samples) + samples * sizeof(uint64_t);
+  }
+  bool ok = unstdtest_write_file_atomic(path, buffer, size);
+  free(buffer);
+  return ok;
+}
+
+/**
+ * @brief Prints the statistics of a finished benchmark and compares it against
+ * the loaded baseline. A slowdown counts as a regression when the
+ * Mann-Whitney U test finds it significant and the median grew by more than
+ * BENCH_THRESHOLD percent. Takes ownership of samples.
+ * @param name    Name of the benchmark.
+ * @param samples Measured durations in nanoseconds.
+ * @param count   Number of samples.
+ */
+static inline void unstdtest_bench_report(const char *name,
+                                          unsigned long long *samples,
+                                          unsigned int count) {
+  qsort(samples, count, sizeof(*samples), unstdtest_compare_ull);
+  double median = unstdtest_median(samples, count);
+  fprintf(stdout,
+          "BENCH: MEDIAN: (%.0f ns) | MIN: (%llu ns) | MAX: (%llu ns) | "
+          "SAMPLES: (%u)\n",
+          median, count ? samples[0] : 0, count ? samples[count - 1] : 0,
+          count);
+
+  for (size_t r = 0; r < BENCH_BASELINE_COUNT; ++r) {
+    struct TBenchRecord *base = &BENCH_BASELINE[r];
+    if (strcmp(base->name, name) != 0) {
+      continue;
+    }
+    qsort(base->samples, base->count, sizeof(*base->samples),
+          unstdtest_compare_ull);
+    double base_median = unstdtest_median(base->samples, base->count);
+    double change =
+        base_median > 0.0 ? (median - base_median) * 100.0 / base_median : 0.0;
+    bool regressed = change > BENCH_THRESHOLD &&
+                     unstdtest_significantly_slower(base->samples, base->count,
+                                                    samples, count);
+    fprintf(stdout, "%s \tBASELINE MEDIAN: (%.0f ns) | CHANGE: (%+.2f%%)%s\n",
+            regressed ? "-" : "+", base_median, change,
+            regressed ? " Error: significant slowdown." : " Ok.");
+    if (regressed) {
+      TOTAL_REGRESSION_COUNTER++;
+    }
+    break;
+  }
+
+  struct TBenchRecord *results = realloc(
+      BENCH_RESULTS, (BENCH_RESULTS_COUNT + 1) * sizeof(*BENCH_RESULTS));
+  char *copy = malloc(strlen(name) + 1);
+  if (results == NULL || copy == NULL) {
+    BENCH_RESULTS = results != NULL ? results : BENCH_RESULTS;
+    free(copy);
+    free(samples);
+    return;
+  }
+  BENCH_RESULTS = results;
+  BENCH_RESULTS[BENCH_RESULTS_COUNT++] = (struct TBenchRecord){
+      .name = strcpy(copy, name), .samples = samples, .count = count};
+}
+
+/**
+ * @brief Saves the measured benchmarks if requested and releases all
+ * benchmark records.
+ */
+static inline void unstdtest_bench_finish(void) {
+  if (BENCH_SAVE_PATH != NULL && !unstdtest_bench_save(BENCH_SAVE_PATH)) {
+    fprintf(stderr, "unstdtest: could not write benchmark baseline '%s'.\n",
+            BENCH_SAVE_PATH);
+  }
+  unstdtest_bench_free(BENCH_RESULTS, BENCH_RESULTS_COUNT);
+  unstdtest_bench_free(BENCH_BASELINE, BENCH_BASELINE_COUNT);
+  BENCH_RESULTS = BENCH_BASELINE = NULL;
+  BENCH_RESULTS_COUNT = BENCH_BASELINE_COUNT = 0;
+}
+
+/**
+ * @brief Creates the trace buffer of the calling thread and publishes it with
+ * a lock-free push onto TRACE_BUFFERS.
+ * @return The new buffer, or NULL if it could not be allocated.
+ */
+static __attribute__((cold, unused)) struct TTraceBuffer *
+unstdtest_trace_buffer_new(void) {
+  struct TTraceBuffer *buffer = calloc(1, sizeof(*buffer));
+  if (buffer == NULL) {
+    return NULL;
+  }
+  buffer->tid = atomic_fetch_add(&TRACE_THREADS, 1) + 1;
+  buffer->next = atomic_load(&TRACE_BUFFERS);
+  while (!atomic_compare_exchange_weak(&TRACE_BUFFERS, &buffer->next, buffer)) {
+  }
+  TRACE_BUFFER = buffer;
+  return buffer;
+}
+
+/**
+ * @brief Records a trace event with an id. Async spans use the phases 'b' and
+ * 'e' with the same nonzero id, so spans that overlap on one thread are shown
+ * on tracks of their own instead of being nested.
+ * @param name     Name of the traced span, must outlive the run.
+ * @param category Kind of the traced span, such as "async".
+ * @param phase    'B', 'E', 'b' or 'e'.
+ * @param id       Id of an async span, NULL for 'B' and 'E'.
+ */
+static inline void unstdtest_trace_id(const char *name, const char *category,
+                                      char phase, const void *id) {
+  if (!atomic_load_explicit(&TRACE_ENABLED, memory_order_relaxed)) {
+    return;
+  }
+  struct TTraceBuffer *buffer = TRACE_BUFFER;
+  if (buffer == NULL && (buffer = unstdtest_trace_buffer_new()) == NULL) {
+    return;
+  }
+  unsigned long long head =
+      atomic_load_explicit(&buffer->head, memory_order_relaxed);
+  struct TTraceEvent *event = &buffer->events[head % TRACE_BUFFER_EVENTS];
+  event->name = name;
+  event->category = category;
+  event->timestamp = unstdtest_now_ns();
+  event->id = (uintptr_t)id;
+  event->phase = phase;
+  atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief Records a trace event into the ring buffer of the calling thread.
+ * Does nothing unless tracing was enabled with --trace. Threads started by a
+ * test must stop recording before MAIN returns, as the dump frees the buffers
+ * of every thread.
+ * @param name     Name of the traced function or group, must outlive the run.
+ * @param category Kind of the traced span, such as "function" or "group".
+ * @param phase    'B' for begin or 'E' for end.
+ */
+static inline void unstdtest_trace(const char *name, const char *category,
+                                   char phase) {
+  unstdtest_trace_id(name, category, phase, NULL);
+}
+
+/**
+ * @brief Writes a string as a quoted JSON string.
+ */
+static inline void unstdtest_json_string(FILE *file, const char *string) {
+  fputc('"', file);
+  for (const unsigned char *c = (const unsigned char *)string; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      fprintf(file, "\\%c", *c);
+    } else if (*c < 0x20) {
+      fprintf(file, "\\u%04x", *c);
+    } else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+/**
+ * @brief Writes every recorded event as Chrome trace_event JSON, viewable in
+ * Perfetto or chrome://tracing, and releases the trace buffers. Tracing is
+ * disabled first, but the dump must still run after all traced threads have
+ * finished. End events whose begin was overwritten in a full ring are
+ * skipped.
+ * @param path Path of the JSON file.
+ * @return true on success.
+ */
+static inline bool unstdtest_trace_dump(const char *path) {
+  atomic_store(&TRACE_ENABLED, false);
+  FILE *file = fopen(path, "w");
+  struct TTraceBuffer *buffer = atomic_exchange(&TRACE_BUFFERS, NULL);
+  const char *separator = "";
+  int pid = (int)getpid();
+  if (file != NULL) {
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  }
+  while (buffer != NULL) {
+    unsigned long long head =
+        atomic_load_explicit(&buffer->head, memory_order_acquire);
+    unsigned long long first =
+        head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+    if (file != NULL) {
+      fprintf(file,
+              "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+              "\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+              separator, pid, buffer->tid, buffer->tid);
+      separator = ",";
+    }
+    unsigned long long depth = 0;
+    for (unsigned long long i = first; file != NULL && i < head; ++i) {
+      struct TTraceEvent *event = &buffer->events[i % TRACE_BUFFER_EVENTS];
+      if (event->phase == 'B') {
+        depth++;
+      } else if (event->phase == 'E') {
+        if (depth == 0) {
+          continue;
+        }
+        depth--;
+      }
+      fprintf(file, ",\n{\"name\":");
+      unstdtest_json_string(file, event->name);
+      fprintf(file, ",\"cat\":");
+      unstdtest_json_string(file, event->category);
+      fprintf(file, ",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":%d,\"tid\":%u",
+              event->phase, event->timestamp / 1000, event->timestamp % 1000,
+              pid, buffer->tid);
+      if (event->id != 0) {
+        fprintf(file, ",\"id\":\"0x%llx\"", (unsigned long long)event->id);
+      }
+      fputc('}', file);
+    }
+    struct TTraceBuffer *next = buffer->next;
+    free(buffer);
+    buffer = next;
+  }
+  TRACE_BUFFER = NULL;
+  if (file == NULL) {
+    return false;
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+}
+
+/**
+ * @brief Writes the trace to TRACE_PATH when the process exits, also when a
+ * failed required assertion stops the run early. Registered with atexit by
+ * MAIN.
+ */
+static inline void unstdtest_trace_atexit(void) {
+  if (TRACE_PATH != NULL && !unstdtest_trace_dump(TRACE_PATH)) {
+    fprintf(stderr, "unstdtest: could not write trace '%s'.\n", TRACE_PATH);
+  }
+}
+
+/**
+ * @brief Resource usage of the process at one point in time, or the change
+ * between two points.
+ */
+struct TUsage {
+  /* Current resident set size in bytes, -1 if unknown. */
+  long long rss;
+  /* Peak resident set size in bytes. */
+  long long max_rss;
+  long long minor_faults, major_faults;
+  long long voluntary_switches, involuntary_switches;
+  /* Number of open file descriptors, -1 if unknown. */
+  int open_fds;
+};
+
+/**
+ * @brief Change of resource usage over one test function.
+ */
+struct TUsageRecord {
+  const char *name;
+  struct TUsage delta;
+};
+
+#ifndef USAGE_WORST_COUNT
+#define USAGE_WORST_COUNT 5
+#endif
+
+static bool USAGE_ENABLED = false;
+static __attribute__((unused)) struct TUsage FUNCTION_USAGE;
+
+/* Resident set size saved by RSS_CHECKPOINT, -1 when none was taken in the
+ * running test function. */
+static long long RSS_CHECKPOINT_BYTES = -1;
+static struct TUsageRecord USAGE_WORST[USAGE_WORST_COUNT];
+static size_t USAGE_WORST_RECORDS = 0;
+
+/**
+ * @brief Counts the open file descriptors of the process.
+ * @return The count, or -1 if the descriptor directory is not available.
+ */
+static inline int unstdtest_open_fds(void) {
+  DIR *dir = opendir("/proc/self/fd");
+  if (dir == NULL) {
+    dir = opendir("/dev/fd");
+  }
+  if (dir == NULL) {
+    return -1;
+  }
+  int count = 0;
+  for (struct dirent *entry; (entry = readdir(dir)) != NULL;) {
+    count += entry->d_name[0] != '.';
+  }
+  closedir(dir);
+  /* The directory stream holds a descriptor of its own. */
+  return count - 1;
+}
+
+/**
+ * @brief Reads the current resident set size of the process.
+ * @return The size in bytes, or -1 if /proc/self/statm is not available.
+ */
+static inline long long unstdtest_current_rss(void) {
+  FILE *file = fopen("/proc/self/statm", "r");
+  long long size = 0, resident = -1;
+  if (file == NULL) {
+    return -1;
+  }
+  if (fscanf(file, "%lld %lld", &size, &resident) != 2) {
+    resident = -1;
+  }
+  fclose(file);
+  return resident < 0 ? -1 : resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * @brief Samples the resource usage of the process.
+ * @param usage    Filled with the current usage.
+ * @param with_fds Whether to count open file descriptors too.
+ */
+static inline void unstdtest_usage(struct TUsage *usage, bool with_fds) {
+  struct rusage ru;
+  memset(usage, 0, sizeof(*usage));
+  usage->rss = unstdtest_current_rss();
+  if (getrusage(RUSAGE_SELF, &ru) == 0) {
+#ifdef __APPLE__
+    usage->max_rss = ru.ru_maxrss;
+#else
+    usage->max_rss = ru.ru_maxrss * 1024ll;
+#endif
+    usage->minor_faults = ru.ru_minflt;
+    usage->major_faults = ru.ru_majflt;
+    usage->voluntary_switches = ru.ru_nvcsw;
+    usage->involuntary_switches = ru.ru_nivcsw;
+  }
+  usage->open_fds = with_fds ? unstdtest_open_fds() : -1;
+}
+
+/**
+ * @brief Returns the resident set size used to measure RSS growth: the current
+ * size where the system reports it, the peak size otherwise.
+ */
+static inline long long unstdtest_rss(void) {
+  long long rss = unstdtest_current_rss();
+  if (rss < 0) {
+    struct TUsage now;
+    unstdtest_usage(&now, false);
+    rss = now.max_rss;
+  }
+  return rss;
+}
+
+/**
+ * @brief Returns how many bytes the RSS grew since the last RSS_CHECKPOINT, 0
+ * if it shrank.
+ */
+static inline unsigned long long unstdtest_rss_growth(void) {
+  long long rss = unstdtest_rss();
+  return rss > RSS_CHECKPOINT_BYTES
+             ? (unsigned long long)(rss - RSS_CHECKPOINT_BYTES)
+             : 0;
+}
+
+/**
+ * @brief Prints the resource usage of the finished test function when
+ * --rusage is given and remembers it if it is among the worst so far.
+ * @param name        Name of the test function.
+ * @param start       Usage sampled when the test function started.
+ * @param overlapping Whether other tests ran at the same time. Their usage is
+ * mixed into the change, so it is printed marked as such but not ranked.
+ */
+static inline void unstdtest_usage_report(const char *name,
+                                          const struct TUsage *start,
+                                          bool overlapping) {
+  if (!USAGE_ENABLED) {
+    return;
+  }
+  struct TUsage now;
+  unstdtest_usage(&now, true);
+  struct TUsage delta = {
+      .rss = now.rss - start->rss,
+      .max_rss = now.max_rss - start->max_rss,
+      .minor_faults = now.minor_faults - start->minor_faults,
+      .major_faults = now.major_faults - start->major_faults,
+      .voluntary_switches = now.voluntary_switches - start->voluntary_switches,
+      .involuntary_switches =
+          now.involuntary_switches - start->involuntary_switches,
+      .open_fds = now.open_fds - start->open_fds,
+  };
+  fprintf(stdout,
+          "RSS: (%+lld KiB, peak %+lld KiB) | PAGE FAULTS: (%lld minor, "
+          "%lld major) | CONTEXT SWITCHES: (%lld voluntary, %lld "
+          "involuntary) | FDS: (%+d)%s\r\n",
+          delta.rss / 1024, delta.max_rss / 1024, delta.minor_faults,
+          delta.major_faults, delta.voluntary_switches,
+          delta.involuntary_switches, delta.open_fds,
+          overlapping ? " | OVERLAPPING OTHER TESTS, NOT RANKED" : "");
+
+  /* Keep the worst functions sorted by RSS growth, then by leaked fds. Only
+   * functions that grew either are worth listing. */
+  if (overlapping || (delta.rss <= 0 && delta.open_fds <= 0)) {
+    return;
+  }
+  size_t slot = USAGE_WORST_RECORDS;
+  while (slot > 0) {
+    const struct TUsage *other = &USAGE_WORST[slot - 1].delta;
+    if (other->rss > delta.rss ||
+        (other->rss == delta.rss && other->open_fds >= delta.open_fds)) {
+      break;
+    }
+    slot--;
+  }
+  if (slot == USAGE_WORST_COUNT) {
+    return;
+  }
+  size_t last = USAGE_WORST_RECORDS < USAGE_WORST_COUNT
+                    ? USAGE_WORST_RECORDS++
+                    : USAGE_WORST_COUNT - 1;
+  memmove(&USAGE_WORST[slot + 1], &USAGE_WORST[slot],
+          (last - slot) * sizeof(USAGE_WORST[0]));
+  USAGE_WORST[slot] = (struct TUsageRecord){.name = name, .delta = delta};
+}
+
+/**
+ * @brief Prints the test functions that grew the RSS or leaked file
+ * descriptors the most, when --rusage is given.
+ */
+static inline void unstdtest_usage_summary(void) {
+  if (!USAGE_ENABLED || USAGE_WORST_RECORDS == 0) {
+    return;
+  }
+  fprintf(stdout, "\r\nWORST RESOURCE USAGE:\r\n");
+  fprintf(stdout, "%12s %12s %10s %10s %10s %10s %6s  %s\r\n", "RSS (KiB)",
+          "PEAK (KiB)", "MINOR PF", "MAJOR PF", "VOL CS", "INVOL CS", "FDS",
+          "FUNCTION");
+  for (size_t i = 0; i < USAGE_WORST_RECORDS; ++i) {
+    const struct TUsage *delta = &USAGE_WORST[i].delta;
+    fprintf(stdout, "%+12lld %+12lld %10lld %10lld %10lld %10lld %+6d  %s\r\n",
+            delta->rss / 1024, delta->max_rss / 1024, delta->minor_faults,
+            delta->major_faults, delta->voluntary_switches,
+            delta->involuntary_switches, delta->open_fds,
+            USAGE_WORST[i].name);
+  }
+}
+
+/**
+ * @brief Saves the current RSS as the baseline of ASSERT_MAX_RSS_GROWTH in the
+ * running test function.
+ */
+#define RSS_CHECKPOINT() (RSS_CHECKPOINT_BYTES = unstdtest_rss())
+
+/**
+ * @brief Checks if the RSS grew by at most the given number of bytes since the
+ * last RSS_CHECKPOINT() of the running test function. The current RSS is read
+ * from /proc/self/statm; systems without it compare the peak RSS instead.
+ * @param TESTDESC A human-readable description explaining the test.
+ * @param bytes    The largest growth allowed, in bytes.
+ * @param required Indicates whether the test process should panic if the test
+ * fails.
+ */
+#define ASSERT_MAX_RSS_GROWTH(TESTDESC, bytes, required)                       \
+  do {                                                                         \
+    if (RSS_CHECKPOINT_BYTES < 0) {                                            \
+      unstdtest_fail_begin(TESTDESC, __FILE__, __LINE__);                      \
+      fprintf(stdout, "no RSS_CHECKPOINT() before this assertion.\n");         \
+      unstdtest_fail_end(required);                                            \
+      break;                                                                   \
+    }                                                                          \
+    unsigned long long unstdtest_growth = unstdtest_rss_growth();              \
+    if (unstdtest_growth > (unsigned long long)(bytes)) {                      \
+      unstdtest_fail(TESTDESC, __FILE__, __LINE__, T_REL_LTE,                  \
+                     T_VALUE(T_SIZE, u, unstdtest_growth),                     \
+                     T_VALUE(T_SIZE, u, (bytes)), required);                   \
+    } else {                                                                   \
+      unstdtest_pass(TESTDESC, __FILE__, __LINE__);                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Reports a crash or timeout of the running test and exits with the
+ * matching status. Only async-signal-safe calls are made.
+ * @param signo The received signal.
+ */
+static inline void unstdtest_signal_handler(int signo) {
+  const char *name = CURRENT_TEST_NAME != NULL ? CURRENT_TEST_NAME : "MAIN";
+  const char *parts[] = {"\r\n!!! ", name,
+                         signo == SIGALRM ? " timed out.\n" : " crashed.\n"};
+  char message[256];
+  size_t len = 0;
+  for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+    for (const char *c = parts[i]; *c != '\0' && len < sizeof(message); ++c) {
+      message[len++] = *c;
+    }
+  }
+  ssize_t written = write(STDERR_FILENO, message, len);
+  (void)written;
+  _exit(signo == SIGALRM ? T_EXIT_TIMEOUT : T_EXIT_CRASHED);
+}
+
+/**
+ * @brief Installs the handlers turning crashes and timeouts of a test into
+ * their exit statuses. The handlers run on an alternate stack, so a test that
+ * overflows its stack is still reported as crashed.
+ */
+static inline void unstdtest_install_signal_handlers(void) {
+  static char signal_stack[SIGNAL_STACK_SIZE];
+  stack_t stack = {.ss_sp = signal_stack, .ss_size = sizeof(signal_stack)};
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = unstdtest_signal_handler;
+  action.sa_flags = SA_RESETHAND;
+  if (sigaltstack(&stack, NULL) == 0) {
+    action.sa_flags |= SA_ONSTACK;
+  }
+  sigemptyset(&action.sa_mask);
+  int signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGALRM};
+  for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); ++i) {
+    sigaction(signals[i], &action, NULL);
+  }
+}
+
+/**
+ * @brief Marks the start of a test function. Output so far is flushed, as the
+ * crash and timeout handlers end the process without flushing stdio.
+ * @param name     Name of the test function.
+ * @param category Trace category of the function.
+ * @param id       Handle of an async test, traced as an async span, or NULL.
+ * @param usage    Receives the resource usage at the start.
+ */
+static inline void unstdtest_test_begin(const char *name, const char *category,
+                                        const void *id, struct TUsage *usage) {
+  fflush(stdout);
+  CURRENT_TEST_NAME = name;
+  TOTAL_FUNCTION_COUNTER++;
+  RSS_CHECKPOINT_BYTES = -1;
+  unstdtest_trace_id(name, category, id != NULL ? 'b' : 'B', id);
+  if (USAGE_ENABLED) {
+    unstdtest_usage(usage, true);
+  }
+  if (TEST_TIMEOUT > 0) {
+    alarm(TEST_TIMEOUT);
+  }
+}
+
+/**
+ * @brief Marks the end of the running test function.
+ * @param name     Name of the test function.
+ * @param category Trace category of the function.
+ * @param id       The handle given to unstdtest_test_begin.
+ */
+static inline void unstdtest_test_end(const char *name, const char *category,
+                                      const void *id) {
+  /* Async tests share one alarm, disarmed when their loop is done. */
+  if (TEST_TIMEOUT > 0 && id == NULL) {
+    alarm(0);
+  }
+  unstdtest_trace_id(name, category, id != NULL ? 'e' : 'E', id);
+  CURRENT_TEST_NAME = NULL;
+}
+
+/**
+ * @brief Tells whether a test should be skipped because the failure limit set
+ * by --fail-fast or --max-failures was reached, and reports it if so.
+ * @param name Name of the test function about to run.
+ * @return true if the test must not run.
+ */
+static inline bool unstdtest_cancelled(const char *name) {
+  if (MAX_FAILURES == 0 || TOTAL_FAILED_COUNTER < MAX_FAILURES) {
+    return false;
+  }
+  TOTAL_CANCELLED_COUNTER++;
+  fprintf(stdout, "xxx %s cancelled, failure limit reached.\n", name);
+  return true;
+}
+
+/**
+ * @brief Computes the exit status of the run from the global counters.
+ */
+static inline int unstdtest_exit_code(void) {
+  if (TOTAL_FAILED_COUNTER > 0) {
+    return T_EXIT_FAILED;
+  }
+  if (TOTAL_REGRESSION_COUNTER > 0) {
+    return T_EXIT_REGRESSION;
+  }
+  if (TOTAL_FUNCTION_COUNTER == 0 && TOTAL_TEST_COUNTER == 0) {
+    return T_EXIT_NO_TESTS;
+  }
+  return T_EXIT_OK;
+}
+
+#ifdef __linux__
+struct TAsync;
+
+/**
+ * @brief Called by the async loop when a watched file descriptor is ready.
+ * @param async  Handle of the test that registered the watch.
+ * @param fd     The ready file descriptor.
+ * @param events Ready epoll events, such as EPOLLIN.
+ * @param data   Pointer given to unstdtest_async_watch.
+ */
+typedef void (*TAsyncCallback)(struct TAsync *async, int fd, uint32_t events,
+                               void *data);
+
+/**
+ * @brief A file descriptor watched on behalf of an async test. Unwatched
+ * entries keep fd -1 and are freed with their test, so events already
+ * returned by epoll_wait never point to freed memory.
+ */
+struct TAsyncWatch {
+  struct TAsync *async;
+  struct TAsyncWatch *next;
+  TAsyncCallback callback;
+  void *data;
+  int fd;
+};
+
+/**
+ * @brief Completion handle of a running async test. It also keeps the per
+ * function counters of the test while other tests run on the loop.
+ */
+struct TAsync {
+  const char *name;
+  struct TAsync *next;
+  struct TAsyncWatch *watches;
+  unsigned long long deadline;
+  unsigned int timeout_ms;
+  unsigned int tests, failed, successful;
+  /* Resource usage when the test started. */
+  struct TUsage usage;
+  /* Whether other async tests were pending while this one ran. */
+  bool overlapping;
+  bool done;
+};
+
+static int ASYNC_EPOLL = -1;
+static bool ASYNC_COLLECTING = false;
+static struct TAsync *ASYNC_PENDING = NULL;
+
+/**
+ * @brief Makes an async test the current one, so assertions made from its
+ * body or callbacks count towards it.
+ */
+static inline void unstdtest_async_enter(struct TAsync *async) {
+  CURRENT_TEST_NAME = async->name;
+  CURRENT_ASYNC_NAME = async->name;
+  TOTAL_TEST_COUNTER_PER_FUNCTION = async->tests;
+  TOTAL_FAILED_COUNTER_PER_FUNCTION = async->failed;
+  TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION = async->successful;
+}
+
+/**
+ * @brief Stores the counters of the current async test back into its handle.
+ */
+static inline void unstdtest_async_leave(struct TAsync *async) {
+  async->tests = TOTAL_TEST_COUNTER_PER_FUNCTION;
+  async->failed = TOTAL_FAILED_COUNTER_PER_FUNCTION;
+  async->successful = TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION;
+  CURRENT_TEST_NAME = NULL;
+  CURRENT_ASYNC_NAME = NULL;
+}
+
+/**
+ * @brief Watches a file descriptor on the loop of the test. The callback runs
+ * on the loop thread each time the descriptor is ready, until the descriptor
+ * is unwatched or the test finishes.
+ * @param async    Handle of the running test.
+ * @param fd       File descriptor to watch, still owned by the caller.
+ * @param events   epoll events to wait for, such as EPOLLIN.
+ * @param callback Function called when the descriptor is ready.
+ * @param data     Pointer passed to the callback.
+ * @return false if the descriptor could not be added to the loop.
+ */
+static inline bool unstdtest_async_watch(struct TAsync *async, int fd,
+                                         uint32_t events,
+                                         TAsyncCallback callback, void *data) {
+  struct TAsyncWatch *watch = malloc(sizeof(*watch));
+  if (watch == NULL) {
+    return false;
+  }
+  *watch = (struct TAsyncWatch){.async = async,
+                                .next = async->watches,
+                                .callback = callback,
+                                .data = data,
+                                .fd = fd};
+  struct epoll_event event = {.events = events, .data.ptr = watch};
+  if (epoll_ctl(ASYNC_EPOLL, EPOLL_CTL_ADD, fd, &event) != 0) {
+    free(watch);
+    return false;
+  }
+  async->watches = watch;
+  return true;
+}
+
+/**
+ * @brief Stops watching a file descriptor registered by the test.
+ */
+static inline void unstdtest_async_unwatch(struct TAsync *async, int fd) {
+  for (struct TAsyncWatch *watch = async->watches; watch; watch = watch->next) {
+    if (watch->fd == fd) {
+      epoll_ctl(ASYNC_EPOLL, EPOLL_CTL_DEL, fd, NULL);
+      watch->fd = -1;
+    }
+  }
+}
+
+/**
+ * @brief Signals that the async test finished. Its watches are removed and
+ * its summary printed once the current callback returns.
+ */
+static inline void unstdtest_async_done(struct TAsync *async) {
+  async->done = true;
+}
+
+/**
+ * @brief Prints the summary of an async test and releases it.
+ * @param async     The test to finish.
+ * @param cancelled Whether the failure limit stopped the test early.
+ */
+static inline void unstdtest_async_finish(struct TAsync *async,
+                                          bool cancelled) {
+  if (cancelled) {
+    TOTAL_CANCELLED_COUNTER++;
+    fprintf(stdout, "xxx %s cancelled, failure limit reached.\n", async->name);
+  } else if (!async->done) {
+    async->tests++;
+    async->failed++;
+    TOTAL_TEST_COUNTER++;
+    TOTAL_FAILED_COUNTER++;
+    fprintf(stdout, "- \t\"%s\" Error: not done after %u ms.\n", async->name,
+            async->timeout_ms);
+  }
+  unstdtest_test_end(async->name, "async", async);
+  fprintf(stdout, "\r\n%s TESTS: (%u) | SUCCESSFUL: (%u) | FAILED: (%u)\r\n",
+          async->name, async->tests, async->successful, async->failed);
+  unstdtest_usage_report(async->name, &async->usage, async->overlapping);
+  fprintf(stdout, "<<<\n");
+  while (async->watches != NULL) {
+    struct TAsyncWatch *watch = async->watches;
+    if (watch->fd >= 0) {
+      epoll_ctl(ASYNC_EPOLL, EPOLL_CTL_DEL, watch->fd, NULL);
+    }
+    async->watches = watch->next;
+    free(watch);
+  }
+  free(async);
+}
+
+/**
+ * @brief Finishes every pending test that is done, past its deadline or
+ * cancelled by the failure limit.
+ * @return Milliseconds until the nearest remaining deadline, or -1 if no test
+ * is pending.
+ */
+static inline int unstdtest_async_reap(void) {
+  unsigned long long now = unstdtest_now_ns(), nearest = 0;
+  bool cancel = MAX_FAILURES > 0 && TOTAL_FAILED_COUNTER >= MAX_FAILURES;
+  struct TAsync **link = &ASYNC_PENDING;
+  while (*link != NULL) {
+    struct TAsync *async = *link;
+    if (async->done || cancel || now >= async->deadline) {
+      *link = async->next;
+      unstdtest_async_finish(async, cancel && !async->done);
+      continue;
+    }
+    if (nearest == 0 || async->deadline < nearest) {
+      nearest = async->deadline;
+    }
+    link = &async->next;
+  }
+  return ASYNC_PENDING == NULL ? -1 : (int)((nearest - now + 999999) / 1000000);
+}
+
+/**
+ * @brief Runs the async loop until every pending test is done or timed out.
+ * Ready descriptors are dispatched to their callbacks in batches, with the
+ * counters of the owning test swapped in around each callback.
+ */
+static inline void unstdtest_async_loop(void) {
+  struct epoll_event events[64];
+  int timeout;
+  while ((timeout = unstdtest_async_reap()) >= 0) {
+    int ready = epoll_wait(ASYNC_EPOLL, events, 64, timeout);
+    for (int i = 0; i < ready; ++i) {
+      struct TAsyncWatch *watch = events[i].data.ptr;
+      if (watch->fd < 0 || watch->async->done) {
+        continue;
+      }
+      unstdtest_async_enter(watch->async);
+      watch->callback(watch->async, watch->fd, events[i].events, watch->data);
+      unstdtest_async_leave(watch->async);
+    }
+  }
+}
+
+/**
+ * @brief Creates the loop shared by the async tests that are about to start.
+ * @return false if the loop could not be created.
+ */
+static inline bool unstdtest_async_open(void) {
+  if (ASYNC_EPOLL < 0) {
+    ASYNC_EPOLL = epoll_create1(EPOLL_CLOEXEC);
+  }
+  if (ASYNC_EPOLL < 0) {
+    fprintf(stdout, "- \tCould not create the async loop.\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Runs all started async tests to completion and closes the loop. The
+ * --timeout alarm covers the whole loop, as the tests run concurrently. The
+ * per function counters of a surrounding test are restored afterwards.
+ */
+static inline void unstdtest_async_close(void) {
+  unsigned int tests = TOTAL_TEST_COUNTER_PER_FUNCTION;
+  unsigned int failed = TOTAL_FAILED_COUNTER_PER_FUNCTION;
+  unsigned int successful = TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION;
+  const char *name = CURRENT_TEST_NAME;
+  if (TEST_TIMEOUT > 0) {
+    alarm(TEST_TIMEOUT);
+  }
+  unstdtest_async_loop();
+  if (TEST_TIMEOUT > 0) {
+    alarm(0);
+  }
+  if (ASYNC_EPOLL >= 0) {
+    close(ASYNC_EPOLL);
+    ASYNC_EPOLL = -1;
+  }
+  TOTAL_TEST_COUNTER_PER_FUNCTION = tests;
+  TOTAL_FAILED_COUNTER_PER_FUNCTION = failed;
+  TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION = successful;
+  CURRENT_TEST_NAME = name;
+}
+
+/**
+ * @brief Starts an async test on the loop. Outside of ASYNC_GROUP_TEST the
+ * test runs to completion on a loop of its own before this returns.
+ * @param name       Name of the test function.
+ * @param timeout_ms Milliseconds the test may take to signal completion.
+ * @param start      Body of the test, registering its work on the loop.
+ */
+static inline void unstdtest_async_run(const char *name,
+                                       unsigned int timeout_ms,
+                                       void (*start)(struct TAsync *)) {
+  bool alone = !ASYNC_COLLECTING;
+  struct TAsync *async = calloc(1, sizeof(*async));
+  fprintf(stdout, ">>> %s\n\n", name);
+  if (async == NULL || !unstdtest_async_open()) {
+    TOTAL_FUNCTION_COUNTER++;
+    free(async);
+    TOTAL_TEST_COUNTER++;
+    TOTAL_FAILED_COUNTER++;
+    fprintf(stdout, "<<<\n");
+    return;
+  }
+  async->name = name;
+  async->timeout_ms = timeout_ms;
+  async->deadline = unstdtest_now_ns() + timeout_ms * 1000000ull;
+  unsigned int tests = TOTAL_TEST_COUNTER_PER_FUNCTION;
+  unsigned int failed = TOTAL_FAILED_COUNTER_PER_FUNCTION;
+  unsigned int successful = TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION;
+  const char *current = CURRENT_TEST_NAME;
+  unstdtest_test_begin(name, "async", async, &async->usage);
+  unstdtest_async_enter(async);
+  start(async);
+  unstdtest_async_leave(async);
+  TOTAL_TEST_COUNTER_PER_FUNCTION = tests;
+  TOTAL_FAILED_COUNTER_PER_FUNCTION = failed;
+  TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION = successful;
+  CURRENT_TEST_NAME = current;
+  for (struct TAsync *other = ASYNC_PENDING; other; other = other->next) {
+    other->overlapping = async->overlapping = true;
+  }
+  async->next = ASYNC_PENDING;
+  ASYNC_PENDING = async;
+  if (alone) {
+    unstdtest_async_close();
+  }
+}
+
+#endif
+
+/**
+ * @brief Parses the value of a numeric command line option.
+ * @param value Text after the '=' of the option.
+ * @param out   Receives the value if it is valid.
+ * @return false if the value is not a non-negative integer that fits.
+ */
+static inline bool unstdtest_parse_uint(const char *value, unsigned int *out) {
+  char *end = NULL;
+  errno = 0;
+  unsigned long parsed = strtoul(value, &end, 10);
+  if (*value < '0' || *value > '9' || *end != '\0' || errno != 0 ||
+      parsed > UINT_MAX) {
+    return false;
+  }
+  *out = (unsigned int)parsed;
+  return true;
+}
+
+/**
+ * @brief Applies the command line options understood by the test runner.
+ * @param argc Number of arguments.
+ * @param argv Argument vector passed to main.
+ */
+static inline void unstdtest_parse_args(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    bool valid = true;
+    if (strcmp(argv[i], "--update-snapshots") == 0) {
+      UPDATE_SNAPSHOTS = true;
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      VERBOSE = true;
+    } else if (strcmp(argv[i], "--fail-fast") == 0) {
+      MAX_FAILURES = 1;
+    } else if (strncmp(argv[i], "--max-failures=", 15) == 0) {
+      valid = unstdtest_parse_uint(argv[i] + 15, &MAX_FAILURES);
+    } else if (strncmp(argv[i], "--timeout=", 10) == 0) {
+      valid = unstdtest_parse_uint(argv[i] + 10, &TEST_TIMEOUT);
+    } else if (strcmp(argv[i], "--rusage") == 0) {
+      USAGE_ENABLED = true;
+    } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+      TRACE_PATH = argv[i] + 8;
+      TRACE_ENABLED = true;
+    } else if (strncmp(argv[i], "--bench-save=", 13) == 0) {
+      BENCH_SAVE_PATH = argv[i] + 13;
+    } else if (strncmp(argv[i], "--bench-baseline=", 17) == 0) {
+      BENCH_BASELINE_PATH = argv[i] + 17;
+    } else if (strncmp(argv[i], "--bench-threshold=", 18) == 0) {
+      char *end = NULL;
+      BENCH_THRESHOLD = strtod(argv[i] + 18, &end);
+      valid = end != argv[i] + 18 && *end == '\0' && BENCH_THRESHOLD >= 0.0;
+    } else {
+      fprintf(stderr, "unstdtest: ignoring unknown option '%s'.\n", argv[i]);
+    }
+    if (!valid) {
+      fprintf(stderr, "unstdtest: invalid value in option '%s'.\n", argv[i]);
+      exit(T_EXIT_USAGE);
+    }
+  }
+  if (BENCH_BASELINE_PATH != NULL &&
+      !unstdtest_bench_load(BENCH_BASELINE_PATH)) {
+    fprintf(stderr, "unstdtest: could not read benchmark baseline '%s'.\n",
+            BENCH_BASELINE_PATH);
+  }
+}
+
 /**
  * @brief Runs one single test.
  * @param func The test function to be executed.
  */
 #define SINGLE_TEST(func)                                                      \
   do {                                                                         \
-    (func)();                                                                  \
+    if (!unstdtest_cancelled(#func)) {                                         \
+      (func)();                                                                \
+    }                                                                          \
   } while (0)
 
 /**
@@ -796,12 +2414,46 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
     char fnamescp[strlen(fnames) + 1];                                         \
     strncpy(fnamescp, fnames, sizeof(fnamescp));                               \
     char *fname = strtok(fnamescp, ", ");                                      \
+    unstdtest_trace(GROUPTESTNAME, "group", 'B');                              \
     for (size_t i = 0; i < count; ++i) {                                       \
-      (funcs[i])();                                                            \
+      if (!unstdtest_cancelled(fname)) {                                       \
+        (funcs[i])();                                                          \
+      }                                                                        \
       fname = strtok(NULL, ", ");                                              \
     }                                                                          \
+    unstdtest_trace(GROUPTESTNAME, "group", 'E');                              \
   } while (0)
 
+#ifdef __linux__
+/**
+ * @brief Runs a group of async tests concurrently on one thread. Every test is
+ * started in order, then the loop runs until all of them are done or timed
+ * out.
+ * @param GROUPTESTNAME A human-readable name to identify the group of tests.
+ * @param ... Async test functions to be run.
+ */
+#define ASYNC_GROUP_TEST(GROUPTESTNAME, ...)                                   \
+  do {                                                                         \
+    void (*funcs[])(void) = {__VA_ARGS__};                                     \
+    const char *fnames = #__VA_ARGS__;                                         \
+    size_t count = sizeof(funcs) / sizeof(funcs[0]);                           \
+    char fnamescp[strlen(fnames) + 1];                                         \
+    strncpy(fnamescp, fnames, sizeof(fnamescp));                               \
+    char *fname = strtok(fnamescp, ", ");                                      \
+    unstdtest_trace(GROUPTESTNAME, "group", 'B');                              \
+    ASYNC_COLLECTING = true;                                                   \
+    for (size_t i = 0; i < count; ++i) {                                       \
+      if (!unstdtest_cancelled(fname)) {                                       \
+        (funcs[i])();                                                          \
+      }                                                                        \
+      fname = strtok(NULL, ", ");                                              \
+    }                                                                          \
+    ASYNC_COLLECTING = false;                                                  \
+    unstdtest_async_close();                                                   \
+    unstdtest_trace(GROUPTESTNAME, "group", 'E');                              \
+  } while (0)
+#endif
+
 /**
  * @brief Create test function with more information.
  * @param FUNCNAME Name of test function.
@@ -816,11 +2468,66 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
     TOTAL_FAILED_COUNTER_PER_FUNCTION = 0;                                     \
     TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION = 0;                                 \
     fprintf(stdout, ">>> %s\n\n", #FUNCNAME);                                  \
+    unstdtest_test_begin(#FUNCNAME, "function", NULL, &FUNCTION_USAGE);        \
     __VA_ARGS__;                                                               \
+    unstdtest_test_end(#FUNCNAME, "function", NULL);                           \
     fprintf(stdout, "\r\nTESTS: (%u) | SUCCESSFUL: (%u) | FAILED: (%u)\r\n",   \
             TOTAL_TEST_COUNTER_PER_FUNCTION,                                   \
             TOTAL_SUCCESSFUL_COUNTER_PER_FUNCTION,                             \
             TOTAL_FAILED_COUNTER_PER_FUNCTION);                                \
+    unstdtest_usage_report(#FUNCNAME, &FUNCTION_USAGE, false);                 \
+    fprintf(stdout, "<<<\n");                                                  \
+  }
+
+#ifdef __linux__
+/**
+ * @brief Create async test function. The body runs with a completion handle
+ * named ASYNC, registers its work on the runner's epoll loop with
+ * unstdtest_async_watch and returns. The test finishes when a callback calls
+ * unstdtest_async_done(ASYNC), or fails when TIMEOUT_MS elapse first.
+ * @param FUNCNAME Name of test function.
+ * @param TIMEOUT_MS Milliseconds the test may take to signal completion.
+ * @param ... Place a block of code that will run in the function.
+ */
+#define ASYNC_FUNCTION(FUNCNAME, TIMEOUT_MS, ...)                              \
+  static void FUNCNAME##_async(struct TAsync *ASYNC) {                         \
+    (void)ASYNC;                                                               \
+    __VA_ARGS__;                                                               \
+  }                                                                            \
+  void FUNCNAME(void);                                                         \
+  void FUNCNAME(void) {                                                        \
+    unstdtest_async_run(#FUNCNAME, TIMEOUT_MS, FUNCNAME##_async);              \
+  }
+#endif
+
+/**
+ * @brief Create benchmark function that times its body repeatedly.
+ * Each run of the body is one sample; the summary reports the median and the
+ * run is compared against --bench-baseline when one was given.
+ * @param BENCHNAME Name of benchmark function.
+ * @param SAMPLES Number of times the body is run and timed.
+ * @param ... Place a block of code that will be timed.
+ */
+#define BENCHMARK(BENCHNAME, SAMPLES, ...)                                     \
+  void BENCHNAME(void);                                                        \
+  void BENCHNAME(void) {                                                       \
+    unsigned int unstdtest_count = (SAMPLES);                                  \
+    unsigned long long *unstdtest_samples =                                    \
+        malloc((unstdtest_count + 1) * sizeof(unsigned long long));            \
+    fprintf(stdout, ">>> %s\n\n", #BENCHNAME);                                 \
+    if (unstdtest_samples == NULL) {                                           \
+      fprintf(stdout, "- \tCould not allocate benchmark samples.\n<<<\n");     \
+      return;                                                                  \
+    }                                                                          \
+    unstdtest_test_begin(#BENCHNAME, "benchmark", NULL, &FUNCTION_USAGE);      \
+    for (unsigned int unstdtest_i = 0; unstdtest_i < unstdtest_count;          \
+         ++unstdtest_i) {                                                      \
+      unsigned long long unstdtest_start = unstdtest_now_ns();                 \
+      __VA_ARGS__;                                                             \
+      unstdtest_samples[unstdtest_i] = unstdtest_now_ns() - unstdtest_start;   \
+    }                                                                          \
+    unstdtest_test_end(#BENCHNAME, "benchmark", NULL);                         \
+    unstdtest_bench_report(#BENCHNAME, unstdtest_samples, unstdtest_count);    \
     fprintf(stdout, "<<<\n");                                                  \
   }
 
@@ -829,13 +2536,22 @@ static unsigned int TOTAL_TEST_COUNTER = 0, TOTAL_FAILED_COUNTER = 0,
  * @param ... Place a block of code that will run in the main function.
  */
 #define MAIN(...)                                                              \
-  int main(void) {                                                             \
+  int main(int argc, char **argv) {                                            \
+    unstdtest_parse_args(argc, argv);                                          \
+    unstdtest_install_signal_handlers();                                       \
+    atexit(unstdtest_trace_atexit);                                            \
+    unstdtest_trace("MAIN", "main", 'B');                                      \
     __VA_ARGS__;                                                               \
+    unstdtest_trace("MAIN", "main", 'E');                                      \
+    int unstdtest_status = unstdtest_exit_code();                              \
+    unstdtest_usage_summary();                                                 \
+    unstdtest_bench_finish();                                                  \
     fprintf(stdout,                                                            \
             "\r\nTOTAL TESTS: (%u) | TOTAL SUCCESSFUL TESTS: (%u) | TOTAL "    \
-            "FAILED TESTS: (%u) | TOTAL "                                      \
-            "IGNORED TESTS: (%u)\r\n",                                         \
+            "FAILED TESTS: (%u) | TOTAL REGRESSIONS: (%u) | TOTAL "            \
+            "IGNORED TESTS: (%u) | TOTAL CANCELLED TESTS: (%u)\r\n",           \
             TOTAL_TEST_COUNTER, TOTAL_SUCCESSFUL_COUNTER,                      \
-            TOTAL_FAILED_COUNTER, TOTAL_IGNORED_COUNTER);                      \
-    return 0;                                                                  \
+            TOTAL_FAILED_COUNTER, TOTAL_REGRESSION_COUNTER,                    \
+            TOTAL_IGNORED_COUNTER, TOTAL_CANCELLED_COUNTER);                   \
+    return unstdtest_status;                                                   \
   }